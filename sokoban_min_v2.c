@@ -23,6 +23,16 @@ static const GenerationConfig kGenerationConfig = {
     .random_extra_walls_max = 4,
 };
 
+typedef struct {
+    int memory_bounded_fallback;  // 固定バッファで足りない時にメモリ制限モードで探索するか
+    size_t memory_limit_bytes;    // メモリ制限モードで次層候補に使うRAM上限（超えた分は一時ファイルへ）
+} SolverConfig;
+
+static const SolverConfig kSolverConfig = {
+    .memory_bounded_fallback = 1,
+    .memory_limit_bytes = (size_t)64 << 20,
+};
+
 // ステージデータ（同じサイズのステージを複数保持）
 static const int gMaps[][H*W] = {
     {
@@ -205,6 +215,14 @@ typedef struct {
     unsigned char player_cell;
 } SolverState;
 
+// 壁以外のセルに通し番号(bit)を振った盤面情報
+typedef struct {
+    int cell_to_bit[H*W];
+    int bit_to_cell[H*W];
+    int cell_count;
+    int num_boxes;
+} SolverBoard;
+
 static int solver_boxes_on_goals(uint64_t boxes_bits, const int *bit_to_cell, int cell_count) {
     for (int bit=0; bit<cell_count; ++bit) {
         if (!(boxes_bits & (1ULL << bit))) continue;
@@ -216,6 +234,36 @@ static int solver_boxes_on_goals(uint64_t boxes_bits, const int *bit_to_cell, in
     return 1;
 }
 
+// 1手分の遷移を求める。移動（または押し）が可能なら1を返す
+static int solver_try_move(const SolverBoard *board, uint64_t boxes_bits, int player_cell,
+                           int dir, uint64_t *out_boxes, int *out_cell) {
+    static const int dx[4] = { 1, -1, 0, 0 };
+    static const int dy[4] = { 0, 0, -1, 1 };
+
+    int nx = player_cell % W + dx[dir];
+    int ny = player_cell / W + dy[dir];
+    if (nx < 0 || nx >= W || ny < 0 || ny >= H) return 0;
+    int next_cell = idx(ny, nx);
+    if (base_map_[next_cell] == TILE_WALL) return 0;
+    int next_bit = board->cell_to_bit[next_cell];
+    uint64_t new_boxes = boxes_bits;
+    if (next_bit >= 0 && (boxes_bits & (1ULL << next_bit))) {
+        int bx = nx + dx[dir];
+        int by = ny + dy[dir];
+        if (bx < 0 || bx >= W || by < 0 || by >= H) return 0;
+        int box_cell = idx(by, bx);
+        if (base_map_[box_cell] == TILE_WALL) return 0;
+        int box_bit = board->cell_to_bit[box_cell];
+        if (box_bit < 0) return 0;
+        if (boxes_bits & (1ULL << box_bit)) return 0;
+        new_boxes &= ~(1ULL << next_bit);
+        new_boxes |= (1ULL << box_bit);
+    }
+    *out_boxes = new_boxes;
+    *out_cell = next_cell;
+    return 1;
+}
+
 static int solver_enqueue(SolverState *queue, int max_states, int *tail,
                           uint64_t boxes_bits, int player_cell,
                           uint64_t *visited_boxes, unsigned char *visited_player,
@@ -238,40 +286,12 @@ static int solver_enqueue(SolverState *queue, int max_states, int *tail,
     return 1;
 }
 
-static int is_current_stage_solvable(void) {
-    int cell_to_bit[H*W];
-    int bit_to_cell[H*W];
-    memset(cell_to_bit, -1, sizeof(cell_to_bit));
-
-    int cell_count = 0;
-    for (int i=0; i<H*W; ++i) {
-        if (base_map_[i] != TILE_WALL) {
-            cell_to_bit[i] = cell_count;
-            bit_to_cell[cell_count] = i;
-            cell_count++;
-        }
-    }
-
-    if (cell_count <= 0) return 0;
-
-    uint64_t start_boxes = 0;
-    int num_boxes = 0;
-    for (int i=0; i<H*W; ++i) {
-        if (!box_map_[i]) continue;
-        int bit = cell_to_bit[i];
-        if (bit < 0) return 0;
-        start_boxes |= (1ULL << bit);
-        num_boxes++;
-    }
-    if (num_boxes == 0) return 0;
-
-    int player_cell = idx(py, px);
-    if (cell_to_bit[player_cell] < 0) return 0;
-
+// 固定サイズのバッファで探索する。解あり=1, 解なし=0, バッファ不足=-1
+static int solver_search_in_memory(const SolverBoard *board, uint64_t start_boxes, int player_cell) {
     const int kMaxStates = 1 << 17;       // 131072
     const int kVisitedCapacity = 1 << 18; // 262144 (power of two)
     SolverState *queue = malloc(sizeof(SolverState) * kMaxStates);
-    if (!queue) return 0;
+    if (!queue) return -1;
 
     uint64_t *visited_boxes = malloc(sizeof(uint64_t) * kVisitedCapacity);
     unsigned char *visited_player = malloc(sizeof(unsigned char) * kVisitedCapacity);
@@ -281,7 +301,7 @@ static int is_current_stage_solvable(void) {
         free(visited_boxes);
         free(visited_player);
         free(visited_used);
-        return 0;
+        return -1;
     }
     memset(visited_used, 0, sizeof(unsigned char) * kVisitedCapacity);
 
@@ -295,47 +315,24 @@ static int is_current_stage_solvable(void) {
         free(visited_boxes);
         free(visited_player);
         free(visited_used);
-        return 0;
+        return -1;
     }
 
-    const int dx[4] = { 1, -1, 0, 0 };
-    const int dy[4] = { 0, 0, -1, 1 };
-
     int solvable = 0;
     int head = 0;
     while (head < tail) {
         SolverState st = queue[head++];
-        if (solver_boxes_on_goals(st.boxes_bits, bit_to_cell, cell_count)) {
+        if (solver_boxes_on_goals(st.boxes_bits, board->bit_to_cell, board->cell_count)) {
             solvable = 1;
             break;
         }
 
-        int py_local = st.player_cell / W;
-        int px_local = st.player_cell % W;
-
         for (int dir=0; dir<4; ++dir) {
-            int nx = px_local + dx[dir];
-            int ny = py_local + dy[dir];
-            if (nx < 0 || nx >= W || ny < 0 || ny >= H) continue;
-            int next_cell = idx(ny, nx);
-            if (base_map_[next_cell] == TILE_WALL) continue;
-            int next_bit = cell_to_bit[next_cell];
-            uint64_t new_boxes = st.boxes_bits;
-            if (next_bit >= 0 && (st.boxes_bits & (1ULL << next_bit))) {
-                int bx = nx + dx[dir];
-                int by = ny + dy[dir];
-                if (bx < 0 || bx >= W || by < 0 || by >= H) continue;
-                int box_cell = idx(by, bx);
-                if (base_map_[box_cell] == TILE_WALL) continue;
-                int box_bit = cell_to_bit[box_cell];
-                if (box_bit < 0) continue;
-                if (st.boxes_bits & (1ULL << box_bit)) continue;
-                new_boxes &= ~(1ULL << next_bit);
-                new_boxes |= (1ULL << box_bit);
-            } else {
-                if (next_bit >= 0 && (st.boxes_bits & (1ULL << next_bit))) {
-                    continue;
-                }
+            uint64_t new_boxes;
+            int next_cell;
+            if (!solver_try_move(board, st.boxes_bits, st.player_cell, dir,
+                                 &new_boxes, &next_cell)) {
+                continue;
             }
 
             int res = solver_enqueue(queue, kMaxStates, &tail,
@@ -343,12 +340,9 @@ static int is_current_stage_solvable(void) {
                                      visited_boxes, visited_player,
                                      visited_used, kVisitedCapacity);
             if (res == -1) {
-                solvable = 0;
+                solvable = -1;
                 goto solver_cleanup;
             }
-            if (res == 0) {
-                continue;
-            }
         }
     }
 
@@ -360,6 +354,344 @@ solver_cleanup:
     return solvable;
 }
 
+// --- メモリ制限モード（外部メモリBFS） ---
+// 状態は「箱配置の組合せランク × セル数 + プレイヤーbit」の64bitキーに詰める。
+// キー列は昇順・重複なしで一時ファイルに差分(LEB128)符号化して保存する。
+
+enum { SOLVER_MAX_RUNS = 32 };  // 1層あたりに同時マージするランの上限
+
+static uint64_t solver_binomial_[H*W+1][H*W+1]; // 二項係数（溢れたらUINT64_MAXで飽和）
+static int solver_binomial_ready_;
+
+static void solver_init_binomial(void) {
+    if (solver_binomial_ready_) return;
+    for (int n=0; n<=H*W; ++n) {
+        solver_binomial_[n][0] = 1;
+        for (int k=1; k<=n; ++k) {
+            uint64_t a = solver_binomial_[n-1][k-1];
+            uint64_t b = (k <= n-1) ? solver_binomial_[n-1][k] : 0;
+            solver_binomial_[n][k] = (a > UINT64_MAX - b) ? UINT64_MAX : a + b;
+        }
+    }
+    solver_binomial_ready_ = 1;
+}
+
+static uint64_t solver_pack_state(const SolverBoard *board, uint64_t boxes_bits, int player_cell) {
+    uint64_t rank = 0;
+    int k = 0;
+    for (int bit=0; bit<board->cell_count; ++bit) {
+        if (boxes_bits & (1ULL << bit)) {
+            rank += solver_binomial_[bit][++k];
+        }
+    }
+    return rank * (uint64_t)board->cell_count + (uint64_t)board->cell_to_bit[player_cell];
+}
+
+static void solver_unpack_state(const SolverBoard *board, uint64_t key,
+                                uint64_t *boxes_bits, int *player_cell) {
+    uint64_t rank = key / (uint64_t)board->cell_count;
+    *player_cell = board->bit_to_cell[key % (uint64_t)board->cell_count];
+    uint64_t bits = 0;
+    int c = board->cell_count - 1;
+    for (int k=board->num_boxes; k>0; --k) {
+        while (solver_binomial_[c][k] > rank) c--;
+        bits |= (1ULL << c);
+        rank -= solver_binomial_[c][k];
+        c--;
+    }
+    *boxes_bits = bits;
+}
+
+typedef struct {
+    FILE *fp;
+    uint64_t count;   // 格納キー数
+} SpillFile;
+
+typedef struct {
+    SpillFile *file;
+    uint64_t prev;
+} SpillWriter;
+
+typedef struct {
+    const SpillFile *file;
+    uint64_t remaining;
+    uint64_t key;     // 現在の先頭キー
+    int valid;        // key が有効なら1
+    int error;
+} SpillReader;
+
+static int spill_open(SpillFile *file) {
+    file->fp = tmpfile();
+    file->count = 0;
+    return file->fp != NULL;
+}
+
+static void spill_close(SpillFile *file) {
+    if (file->fp) fclose(file->fp);
+    file->fp = NULL;
+    file->count = 0;
+}
+
+// 昇順で渡されたキーを書き込む（直前と同じキーは捨てる）
+static int spill_write(SpillWriter *w, uint64_t key) {
+    if (w->file->count > 0 && key == w->prev) return 1;
+    uint64_t delta = (w->file->count > 0) ? key - w->prev : key;
+    do {
+        unsigned char byte = delta & 0x7f;
+        delta >>= 7;
+        if (delta) byte |= 0x80;
+        if (putc(byte, w->file->fp) == EOF) return 0;
+    } while (delta);
+    w->prev = key;
+    w->file->count++;
+    return 1;
+}
+
+static void spill_reader_next(SpillReader *r) {
+    r->valid = 0;
+    if (r->remaining == 0) return;
+    uint64_t delta = 0;
+    for (int shift=0; ; shift += 7) {
+        int c = getc(r->file->fp);
+        if (c == EOF || shift >= 64) {
+            r->error = 1;
+            return;
+        }
+        delta |= (uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80)) break;
+    }
+    r->key += delta;
+    r->remaining--;
+    r->valid = 1;
+}
+
+static void spill_reader_start(SpillReader *r, const SpillFile *file) {
+    r->file = file;
+    r->remaining = file->count;
+    r->key = 0;
+    r->error = 0;
+    rewind(file->fp);
+    spill_reader_next(r);
+}
+
+static int spill_from_keys(SpillFile *file, const uint64_t *keys, size_t count) {
+    if (!spill_open(file)) return 0;
+    SpillWriter w = { file, 0 };
+    for (size_t i=0; i<count; ++i) {
+        if (!spill_write(&w, keys[i])) return 0;
+    }
+    return fflush(file->fp) == 0;
+}
+
+// runs の和集合を求め、visited との和集合を merged へ、visited に無いキーを fresh へ書き出す。
+// visited / fresh は NULL 可（ラン同士の統合のみ行う）。
+static int spill_merge(SpillFile *runs, int run_count, const SpillFile *visited,
+                       SpillFile *merged, SpillFile *fresh) {
+    SpillReader readers[SOLVER_MAX_RUNS];
+    SpillReader seen = { 0 };
+    for (int i=0; i<run_count; ++i) {
+        spill_reader_start(&readers[i], &runs[i]);
+    }
+    if (visited) spill_reader_start(&seen, visited);
+
+    SpillWriter merged_w = { merged, 0 };
+    SpillWriter fresh_w = { fresh, 0 };
+    for (;;) {
+        int have_min = 0;
+        uint64_t min_key = 0;
+        for (int i=0; i<run_count; ++i) {
+            if (readers[i].valid && (!have_min || readers[i].key < min_key)) {
+                min_key = readers[i].key;
+                have_min = 1;
+            }
+        }
+        if (!have_min) break;
+
+        while (seen.valid && seen.key < min_key) {
+            if (!spill_write(&merged_w, seen.key)) return 0;
+            spill_reader_next(&seen);
+        }
+        int already_seen = seen.valid && seen.key == min_key;
+        if (!spill_write(&merged_w, min_key)) return 0;
+        if (!already_seen && fresh && !spill_write(&fresh_w, min_key)) return 0;
+
+        for (int i=0; i<run_count; ++i) {
+            if (readers[i].valid && readers[i].key == min_key) {
+                spill_reader_next(&readers[i]);
+            }
+        }
+    }
+    while (seen.valid) {
+        if (!spill_write(&merged_w, seen.key)) return 0;
+        spill_reader_next(&seen);
+    }
+
+    if (seen.error) return 0;
+    for (int i=0; i<run_count; ++i) {
+        if (readers[i].error) return 0;
+    }
+    if (fflush(merged->fp) != 0) return 0;
+    if (fresh && fflush(fresh->fp) != 0) return 0;
+    return 1;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// バッファを整列してランとして退避する。ランが上限に達したら1本にまとめる
+static int spill_flush_run(uint64_t *buffer, size_t *buffer_len,
+                           SpillFile *runs, int *run_count) {
+    if (*buffer_len == 0) return 1;
+    qsort(buffer, *buffer_len, sizeof(uint64_t), compare_u64);
+    if (!spill_from_keys(&runs[*run_count], buffer, *buffer_len)) {
+        spill_close(&runs[*run_count]);
+        return 0;
+    }
+    (*run_count)++;
+    *buffer_len = 0;
+
+    if (*run_count < SOLVER_MAX_RUNS) return 1;
+    SpillFile combined;
+    if (!spill_open(&combined)) return 0;
+    int ok = spill_merge(runs, *run_count, NULL, &combined, NULL);
+    for (int i=0; i<*run_count; ++i) {
+        spill_close(&runs[i]);
+    }
+    runs[0] = combined;
+    *run_count = 1;
+    return ok;
+}
+
+// 層ごとのBFS。次層の候補はRAM上限までバッファし、溢れた分は整列済みランとして
+// 一時ファイルへ書き出す。層の終わりに訪問済みファイルと突き合わせて重複を除く。
+static int solver_search_external(const SolverBoard *board, uint64_t start_boxes, int player_cell) {
+    solver_init_binomial();
+    uint64_t combinations = solver_binomial_[board->cell_count][board->num_boxes];
+    if (combinations == UINT64_MAX ||
+        combinations > UINT64_MAX / (uint64_t)board->cell_count) {
+        return 0;  // 64bitキーに収まらない
+    }
+
+    size_t buffer_capacity = kSolverConfig.memory_limit_bytes / sizeof(uint64_t);
+    if (buffer_capacity < 1024) buffer_capacity = 1024;
+    uint64_t *buffer = malloc(sizeof(uint64_t) * buffer_capacity);
+    if (!buffer) return 0;
+
+    SpillFile runs[SOLVER_MAX_RUNS];
+    int run_count = 0;
+    SpillFile visited = { 0 };
+    SpillFile frontier = { 0 };
+    uint64_t start_key = solver_pack_state(board, start_boxes, player_cell);
+    if (!spill_from_keys(&visited, &start_key, 1) ||
+        !spill_from_keys(&frontier, &start_key, 1)) {
+        spill_close(&visited);
+        spill_close(&frontier);
+        free(buffer);
+        return 0;
+    }
+
+    int solvable = 0;
+    int failed = 0;
+    while (frontier.count > 0 && !solvable && !failed) {
+        size_t buffer_len = 0;
+        SpillReader reader;
+        for (spill_reader_start(&reader, &frontier); reader.valid; spill_reader_next(&reader)) {
+            uint64_t boxes_bits;
+            int cell;
+            solver_unpack_state(board, reader.key, &boxes_bits, &cell);
+            if (solver_boxes_on_goals(boxes_bits, board->bit_to_cell, board->cell_count)) {
+                solvable = 1;
+                break;
+            }
+            for (int dir=0; dir<4; ++dir) {
+                uint64_t new_boxes;
+                int next_cell;
+                if (!solver_try_move(board, boxes_bits, cell, dir, &new_boxes, &next_cell)) {
+                    continue;
+                }
+                buffer[buffer_len++] = solver_pack_state(board, new_boxes, next_cell);
+                if (buffer_len == buffer_capacity &&
+                    !spill_flush_run(buffer, &buffer_len, runs, &run_count)) {
+                    failed = 1;
+                    break;
+                }
+            }
+            if (failed) break;
+        }
+        if (reader.error) failed = 1;
+        if (solvable || failed) break;
+        if (!spill_flush_run(buffer, &buffer_len, runs, &run_count)) {
+            failed = 1;
+            break;
+        }
+
+        SpillFile next_visited = { 0 };
+        SpillFile next_frontier = { 0 };
+        if (!spill_open(&next_visited) || !spill_open(&next_frontier) ||
+            !spill_merge(runs, run_count, &visited, &next_visited, &next_frontier)) {
+            spill_close(&next_visited);
+            spill_close(&next_frontier);
+            failed = 1;
+            break;
+        }
+        for (int i=0; i<run_count; ++i) {
+            spill_close(&runs[i]);
+        }
+        run_count = 0;
+        spill_close(&visited);
+        spill_close(&frontier);
+        visited = next_visited;
+        frontier = next_frontier;
+    }
+
+    for (int i=0; i<run_count; ++i) {
+        spill_close(&runs[i]);
+    }
+    spill_close(&visited);
+    spill_close(&frontier);
+    free(buffer);
+    return solvable;
+}
+
+static int is_current_stage_solvable(void) {
+    SolverBoard board;
+    memset(board.cell_to_bit, -1, sizeof(board.cell_to_bit));
+
+    board.cell_count = 0;
+    for (int i=0; i<H*W; ++i) {
+        if (base_map_[i] != TILE_WALL) {
+            board.cell_to_bit[i] = board.cell_count;
+            board.bit_to_cell[board.cell_count] = i;
+            board.cell_count++;
+        }
+    }
+
+    if (board.cell_count <= 0) return 0;
+
+    uint64_t start_boxes = 0;
+    board.num_boxes = 0;
+    for (int i=0; i<H*W; ++i) {
+        if (!box_map_[i]) continue;
+        int bit = board.cell_to_bit[i];
+        if (bit < 0) return 0;
+        start_boxes |= (1ULL << bit);
+        board.num_boxes++;
+    }
+    if (board.num_boxes == 0) return 0;
+
+    int player_cell = idx(py, px);
+    if (board.cell_to_bit[player_cell] < 0) return 0;
+
+    int result = solver_search_in_memory(&board, start_boxes, player_cell);
+    if (result >= 0) return result;
+    // 固定バッファで足りなければメモリ制限モードで探索し直す
+    if (!kSolverConfig.memory_bounded_fallback) return 0;
+    return solver_search_external(&board, start_boxes, player_cell);
+}
+
 static void build_fallback_stage_layout(void) {
     for (int y=0; y<H; ++y) {
         for (int x=0; x<W; ++x) {